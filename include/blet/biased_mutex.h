@@ -0,0 +1,233 @@
+/**
+ * biased_mutex.h
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * Copyright (c) 2024 BLET Mickaël.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BLET_BIASED_MUTEX_H_
+#define BLET_BIASED_MUTEX_H_
+
+#include <sched.h>
+
+#include "blet/detail/asymmetric_fence.h"
+#include "blet/mutex.h"
+
+namespace blet {
+
+/**
+ * @brief Mutex biased toward the first thread which takes it.
+ *
+ * While the bias is held, the owner thread acquires and releases the mutex
+ * with plain loads and stores: it raises its flag and checks that the bias
+ * was not revoked, the light side of AsymmetricFence (a compiler barrier with
+ * the private expedited membarrier, a full fence otherwise) orders both.
+ *
+ * The first other thread which takes the mutex revokes the bias: it takes
+ * the underlying blet::Mutex, marks the bias as revoked, runs the heavy side
+ * of AsymmetricFence (membarrier) and waits the end of the current hold of
+ * owner (try_lock returns false instead of waiting). Then every thread, owner
+ * included, uses the underlying blet::Mutex.
+ */
+class BiasedMutex {
+  public:
+    /**
+     * @brief Construct a new unbiased BiasedMutex object.
+     *
+     * @param pAttr The attributes of underlying mutex. The biased path does
+     * not honor them (recursive, error checking, ...), so a BiasedMutex with
+     * attributes is constructed revoked.
+     */
+    BiasedMutex(const pthread_mutexattr_t* pAttr = NULL) :
+        mutex_(pAttr),
+        biasOwner_(pAttr == NULL ? BIAS_NONE : BIAS_REVOKED),
+        ownerId_(BIAS_NONE),
+        isOwnerLocked_(0) {}
+
+    /**
+     * @brief Destroy the BiasedMutex object.
+     */
+    ~BiasedMutex() {}
+
+    /**
+     * @brief Locks the mutex.
+     *
+     * @throw blet::Mutex::Exception on error of underlying mutex.
+     */
+    void lock() {
+        if (claimBias() && lockBiased()) {
+            return;
+        }
+        mutex_.lock();
+        revokeBias();
+        // the owner can still hold the bias acquired before the revocation
+        while (isOwnerHolding()) {
+            ::sched_yield();
+        }
+    }
+
+    /**
+     * @brief Tries to lock the mutex.
+     * Returns immediately. The first try of another thread revokes the bias
+     * and returns false if the owner still holds the mutex.
+     */
+    bool try_lock() {
+        if (claimBias() && lockBiased()) {
+            return true;
+        }
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        revokeBias();
+        if (isOwnerHolding()) {
+            mutex_.unlock();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Unlocks the mutex.
+     *
+     * The mutex must be locked by the current thread of execution, otherwise,
+     * the behavior is undefined.
+     *
+     * @throw blet::Mutex::Exception on error of underlying mutex.
+     */
+    void unlock() {
+        // only the owner raises its flag and revocation waits its release
+        if (__atomic_load_n(&ownerId_, __ATOMIC_RELAXED) == threadId() &&
+            __atomic_load_n(&isOwnerLocked_, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&isOwnerLocked_, 0, __ATOMIC_RELEASE);
+        }
+        else {
+            mutex_.unlock();
+        }
+    }
+
+    /**
+     * @return true if the bias was revoked.
+     */
+    bool is_revoked() const {
+        return __atomic_load_n(&biasOwner_, __ATOMIC_ACQUIRE) == BIAS_REVOKED;
+    }
+
+    /**
+     * @return unsigned long Number of revocations of bias of all BiasedMutex
+     * of process.
+     */
+    static unsigned long revocations() {
+        return __atomic_load_n(&revocationCounter(), __ATOMIC_RELAXED);
+    }
+
+  protected:
+    enum {
+        BIAS_NONE = 0,
+        BIAS_REVOKED = 1
+    };
+
+    static unsigned long threadId() {
+        // address of a thread local is unique by living thread
+        static __thread char tag;
+        return reinterpret_cast<unsigned long>(&tag);
+    }
+
+    /**
+     * @return true if the current thread holds the bias.
+     */
+    bool claimBias() {
+        unsigned long self = threadId();
+        unsigned long owner = __atomic_load_n(&biasOwner_, __ATOMIC_RELAXED);
+        // only the first lock of mutex uses an atomic read-modify-write, on
+        // failure owner is the winner of claim
+        if (owner == BIAS_NONE &&
+            __atomic_compare_exchange_n(&biasOwner_, &owner, self, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&ownerId_, self, __ATOMIC_RELAXED);
+            return true;
+        }
+        return owner == self;
+    }
+
+    /**
+     * @return true if the owner acquired the mutex before any revocation.
+     */
+    bool lockBiased() {
+        __atomic_store_n(&isOwnerLocked_, 1, __ATOMIC_RELAXED);
+        detail::AsymmetricFence::light();
+        if (__atomic_load_n(&biasOwner_, __ATOMIC_RELAXED) != BIAS_REVOKED) {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            return true;
+        }
+        // revoked: back out and use the underlying mutex
+        __atomic_store_n(&isOwnerLocked_, 0, __ATOMIC_RELEASE);
+        return false;
+    }
+
+    /**
+     * @return true if the owner holds the mutex by the bias.
+     */
+    bool isOwnerHolding() const {
+        return __atomic_load_n(&isOwnerLocked_, __ATOMIC_ACQUIRE) != 0;
+    }
+
+    /**
+     * @brief Revokes the bias if it is not, under the underlying mutex.
+     * The owner can still hold the mutex by the bias after the call.
+     */
+    void revokeBias() {
+        unsigned long owner = __atomic_load_n(&biasOwner_, __ATOMIC_RELAXED);
+        if (owner == BIAS_REVOKED) {
+            return;
+        }
+        while (!__atomic_compare_exchange_n(&biasOwner_, &owner, BIAS_REVOKED,
+                                            false, __ATOMIC_SEQ_CST,
+                                            __ATOMIC_RELAXED)) {
+        }
+        if (owner == BIAS_NONE) {
+            return;
+        }
+        detail::AsymmetricFence::heavy();
+        __atomic_add_fetch(&revocationCounter(), 1, __ATOMIC_RELAXED);
+    }
+
+    static unsigned long& revocationCounter() {
+        static unsigned long counter = 0;
+        return counter;
+    }
+
+    Mutex mutex_;
+    // BIAS_NONE, BIAS_REVOKED or id of owner thread
+    unsigned long biasOwner_;
+    // id of owner thread kept after the revocation
+    unsigned long ownerId_;
+    int isOwnerLocked_;
+
+  private:
+    BiasedMutex(const BiasedMutex&) {}
+    BiasedMutex& operator=(const BiasedMutex&) {
+        return *this;
+    }
+};
+
+} // namespace blet
+
+#endif // #ifndef BLET_BIASED_MUTEX_H_
@@ -0,0 +1,97 @@
+/**
+ * asymmetric_fence.h
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * Copyright (c) 2024 BLET Mickaël.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BLET_DETAIL_ASYMMETRIC_FENCE_H_
+#define BLET_DETAIL_ASYMMETRIC_FENCE_H_
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// commands of linux/membarrier.h (enumerators since linux 4.14)
+#define BLET_MEMBARRIER_CMD_QUERY_ 0
+#define BLET_MEMBARRIER_CMD_PRIVATE_EXPEDITED_ (1 << 3)
+#define BLET_MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_ (1 << 4)
+
+namespace blet {
+
+namespace detail {
+
+/**
+ * @brief Memory fence split between a frequent light side and a rare heavy
+ * side.
+ *
+ * When the private expedited membarrier is available, the light side is only
+ * a compiler barrier and the heavy side forces a full memory barrier on all
+ * running threads of process. Otherwise both sides are full memory barriers.
+ */
+class AsymmetricFence {
+  public:
+    static void light() {
+        if (expedited()) {
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        }
+        else {
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        }
+    }
+    static void heavy() {
+#if defined(__linux__) && defined(SYS_membarrier)
+        if (expedited()) {
+            ::syscall(SYS_membarrier, BLET_MEMBARRIER_CMD_PRIVATE_EXPEDITED_,
+                      0);
+            return;
+        }
+#endif
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+    static bool expedited() {
+        static const bool isExpedited = registerExpedited();
+        return isExpedited;
+    }
+
+  private:
+    static bool registerExpedited() {
+#if defined(__linux__) && defined(SYS_membarrier)
+        long cmds = ::syscall(SYS_membarrier, BLET_MEMBARRIER_CMD_QUERY_, 0);
+        return cmds > 0 && (cmds & BLET_MEMBARRIER_CMD_PRIVATE_EXPEDITED_) &&
+               !::syscall(SYS_membarrier,
+                          BLET_MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_, 0);
+#else
+        return false;
+#endif
+    }
+};
+
+} // namespace detail
+
+} // namespace blet
+
+#undef BLET_MEMBARRIER_CMD_QUERY_
+#undef BLET_MEMBARRIER_CMD_PRIVATE_EXPEDITED_
+#undef BLET_MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_
+
+#endif // #ifndef BLET_DETAIL_ASYMMETRIC_FENCE_H_
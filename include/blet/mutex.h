@@ -28,9 +28,40 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <time.h>
 
 #include <exception>
 
+#include "blet/detail/cpu_relax.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(BLET_MUTEX_BACKEND_PTHREAD) + defined(BLET_MUTEX_BACKEND_FUTEX) + \
+        defined(BLET_MUTEX_BACKEND_SPIN) +                                 \
+        defined(BLET_MUTEX_BACKEND_INSTRUMENTED) >                         \
+    1
+#error "only one BLET_MUTEX_BACKEND_* can be defined"
+#endif
+
+#if (defined(BLET_MUTEX_BACKEND_FUTEX) || defined(BLET_MUTEX_BACKEND_SPIN)) && \
+    !defined(__linux__)
+#error "futex and spin backends of blet::Mutex require linux"
+#endif
+
+#if !defined(BLET_MUTEX_BACKEND_FUTEX) && !defined(BLET_MUTEX_BACKEND_SPIN)
+// blet::Mutex::native_handle_type is pthread_mutex_t (usable by pthread_cond_*)
+#define BLET_MUTEX_NATIVE_HANDLE_PTHREAD
+#endif
+
+#ifndef BLET_MUTEX_SPIN_COUNT
+// number of spins of the spin backend before parking on the futex
+#define BLET_MUTEX_SPIN_COUNT 100
+#endif
+
 #define BLET_MUTEX_EXCEPTION_EINVAL_                                         \
     "the mutex was created with the protocol attribute having the value "    \
     "PTHREAD_PRIO_PROTECT and the calling thread's priority is higher than " \
@@ -41,11 +72,260 @@
 #define BLET_MUTEX_EXCEPTION_EDEADLK_ \
     "the current thread already owns the mutex"
 #define BLET_MUTEX_EXCEPTION_EPERM_ "the current thread does not own the mutex"
+#define BLET_MUTEX_EXCEPTION_ENOTSUP_ \
+    "the mutex attributes are not supported by the backend"
 
 namespace blet {
 
+/**
+ * Backends of blet::Mutex.
+ *
+ * A backend provides the same interface as the pthread_mutex functions:
+ * lock, trylock and unlock return 0 on success or an errno value on failure.
+ * is_supported tells if the backend honors the attributes of mutex.
+ * The backend of blet::Mutex is selected at build time by defining one of
+ * BLET_MUTEX_BACKEND_PTHREAD (default), BLET_MUTEX_BACKEND_FUTEX,
+ * BLET_MUTEX_BACKEND_SPIN or BLET_MUTEX_BACKEND_INSTRUMENTED.
+ */
+namespace mutex_backend {
+
+/**
+ * @brief Backend on pthread_mutex_t.
+ */
+class Pthread {
+  public:
+    typedef pthread_mutex_t native_handle_type;
+
+    static bool is_supported(const pthread_mutexattr_t* /*pAttr*/) {
+        return true;
+    }
+
+    Pthread(const pthread_mutexattr_t* pAttr) {
+        ::pthread_mutex_init(&mutex_, pAttr);
+    }
+    ~Pthread() {
+        ::pthread_mutex_destroy(&mutex_);
+    }
+    int lock() {
+        return ::pthread_mutex_lock(&mutex_);
+    }
+    int trylock() {
+        return ::pthread_mutex_trylock(&mutex_);
+    }
+    int unlock() {
+        return ::pthread_mutex_unlock(&mutex_);
+    }
+    native_handle_type& native_handle() {
+        return mutex_;
+    }
+
+  protected:
+    pthread_mutex_t mutex_;
+
+  private:
+    Pthread(const Pthread&) {}
+    Pthread& operator=(const Pthread&) {
+        return *this;
+    }
+};
+
+#if defined(__linux__)
+
+/**
+ * @brief Backend on a futex word.
+ *
+ * State of word: 0 unlocked, 1 locked, 2 locked with waiters.
+ * The pthread attributes are not supported.
+ */
+class Futex {
+  public:
+    typedef int native_handle_type;
+
+    static bool is_supported(const pthread_mutexattr_t* pAttr) {
+        return pAttr == NULL;
+    }
+
+    Futex(const pthread_mutexattr_t* /*pAttr*/) :
+        state_(0) {}
+    ~Futex() {}
+    int lock() {
+        int c = 0;
+        if (!__atomic_compare_exchange_n(&state_, &c, 1, false,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            lockSlow(c);
+        }
+        return 0;
+    }
+    int trylock() {
+        int c = 0;
+        if (__atomic_compare_exchange_n(&state_, &c, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return 0;
+        }
+        return EBUSY;
+    }
+    int unlock() {
+        int c = __atomic_exchange_n(&state_, 0, __ATOMIC_RELEASE);
+        if (c == 0) {
+            return EPERM;
+        }
+        if (c == 2) {
+            ::syscall(SYS_futex, &state_, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        }
+        return 0;
+    }
+    native_handle_type& native_handle() {
+        return state_;
+    }
+
+  protected:
+    /**
+     * @brief Marks the word as contended and parks until it is acquired.
+     *
+     * @param c Last state read of word.
+     */
+    void lockSlow(int c) {
+        if (c != 2) {
+            c = __atomic_exchange_n(&state_, 2, __ATOMIC_ACQUIRE);
+        }
+        while (c != 0) {
+            ::syscall(SYS_futex, &state_, FUTEX_WAIT_PRIVATE, 2, NULL, NULL, 0);
+            c = __atomic_exchange_n(&state_, 2, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    int state_;
+
+  private:
+    Futex(const Futex&) {}
+    Futex& operator=(const Futex&) {
+        return *this;
+    }
+};
+
+/**
+ * @brief Backend on a futex word which spins BLET_MUTEX_SPIN_COUNT times
+ * before parking.
+ */
+class Spin : public Futex {
+  public:
+    Spin(const pthread_mutexattr_t* pAttr) :
+        Futex(pAttr) {}
+    ~Spin() {}
+    int lock() {
+        int c = 0;
+        for (int i = 0; i < BLET_MUTEX_SPIN_COUNT; ++i) {
+            c = __atomic_load_n(&state_, __ATOMIC_RELAXED);
+            if (c == 0 &&
+                __atomic_compare_exchange_n(&state_, &c, 1, false,
+                                            __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED)) {
+                return 0;
+            }
+            if (c == 2) {
+                // waiters are already parked
+                break;
+            }
+            detail::cpuRelax();
+        }
+        lockSlow(c);
+        return 0;
+    }
+};
+
+#endif // #if defined(__linux__)
+
+/**
+ * @brief Backend on pthread_mutex_t which counts the acquisitions, the
+ * contended acquisitions and the time waited on contended acquisitions.
+ *
+ * Counters are written under the lock and can be read at any time.
+ */
+class Instrumented : public Pthread {
+  public:
+    Instrumented(const pthread_mutexattr_t* pAttr) :
+        Pthread(pAttr),
+        acquisitions_(0),
+        contentions_(0),
+        waitNs_(0) {}
+    ~Instrumented() {}
+    int lock() {
+        int retLock = Pthread::trylock();
+        if (retLock != EBUSY) {
+            if (!retLock) {
+                increment(acquisitions_, 1);
+            }
+            return retLock;
+        }
+        struct timespec begin;
+        struct timespec end;
+        ::clock_gettime(CLOCK_MONOTONIC, &begin);
+        retLock = Pthread::lock();
+        ::clock_gettime(CLOCK_MONOTONIC, &end);
+        if (!retLock) {
+            increment(acquisitions_, 1);
+            increment(contentions_, 1);
+            increment(waitNs_, (end.tv_sec - begin.tv_sec) * 1000000000L +
+                                   (end.tv_nsec - begin.tv_nsec));
+        }
+        return retLock;
+    }
+    int trylock() {
+        int retLock = Pthread::trylock();
+        if (!retLock) {
+            increment(acquisitions_, 1);
+        }
+        return retLock;
+    }
+
+    /**
+     * @return unsigned long Number of successful lock and trylock.
+     */
+    unsigned long acquisitions() const {
+        return __atomic_load_n(&acquisitions_, __ATOMIC_RELAXED);
+    }
+
+    /**
+     * @return unsigned long Number of lock which waited another thread.
+     */
+    unsigned long contentions() const {
+        return __atomic_load_n(&contentions_, __ATOMIC_RELAXED);
+    }
+
+    /**
+     * @return unsigned long Total of nanoseconds waited by contended lock.
+     */
+    unsigned long wait_ns() const {
+        return __atomic_load_n(&waitNs_, __ATOMIC_RELAXED);
+    }
+
+  protected:
+    static void increment(unsigned long& counter, unsigned long value) {
+        __atomic_store_n(&counter,
+                         __atomic_load_n(&counter, __ATOMIC_RELAXED) + value,
+                         __ATOMIC_RELAXED);
+    }
+
+    unsigned long acquisitions_;
+    unsigned long contentions_;
+    unsigned long waitNs_;
+};
+
+} // namespace mutex_backend
+
 class Mutex {
   public:
+#if defined(BLET_MUTEX_BACKEND_FUTEX)
+    typedef mutex_backend::Futex backend_type;
+#elif defined(BLET_MUTEX_BACKEND_SPIN)
+    typedef mutex_backend::Spin backend_type;
+#elif defined(BLET_MUTEX_BACKEND_INSTRUMENTED)
+    typedef mutex_backend::Instrumented backend_type;
+#else
+    typedef mutex_backend::Pthread backend_type;
+#endif
+    typedef backend_type::native_handle_type native_handle_type;
+
     class Exception : public std::exception {
       public:
         Exception(const Mutex& mutex, int retValue) :
@@ -64,6 +344,9 @@ class Mutex {
                 case EPERM:
                     what_ = BLET_MUTEX_EXCEPTION_EPERM_;
                     break;
+                case ENOTSUP:
+                    what_ = BLET_MUTEX_EXCEPTION_ENOTSUP_;
+                    break;
                 default:
                     what_ = "unknown error";
                     break;
@@ -95,18 +378,20 @@ class Mutex {
      * destroyed while still owned by any threads, or a thread terminates while
      * owning a mutex.
      *
-     * @param pAttr The attributes of mutex.
+     * @param pAttr The attributes of mutex, only supported by pthread backends.
+     * @throw Exception if pAttr is not NULL with futex or spin backends.
      */
-    Mutex(const pthread_mutexattr_t* pAttr = NULL) {
-        ::pthread_mutex_init(&mutex_, pAttr);
+    Mutex(const pthread_mutexattr_t* pAttr = NULL) :
+        backend_(pAttr) {
+        if (!backend_type::is_supported(pAttr)) {
+            throw Exception(*this, ENOTSUP);
+        }
     }
 
     /**
      * @brief Destroy the Mutex object.
      */
-    ~Mutex() {
-        ::pthread_mutex_destroy(&mutex_);
-    }
+    ~Mutex() {}
 
     /**
      * @brief Locks the mutex.
@@ -119,7 +404,7 @@ class Mutex {
      * resource_deadlock_would_occur instead of deadlocking.
      */
     void lock() {
-        int retLock = ::pthread_mutex_lock(&mutex_);
+        int retLock = backend_.lock();
         if (retLock) {
             throw Exception(*this, retLock);
         }
@@ -137,7 +422,7 @@ class Mutex {
      * behavior is undefined.
      */
     bool try_lock() {
-        int retLock = ::pthread_mutex_trylock(&mutex_);
+        int retLock = backend_.trylock();
         return !retLock;
     }
 
@@ -151,24 +436,34 @@ class Mutex {
      * subsequent lock operation that obtains ownership of the same mutex.
      */
     void unlock() {
-        int retUnlock = ::pthread_mutex_unlock(&mutex_);
+        int retUnlock = backend_.unlock();
         if (retUnlock) {
             throw Exception(*this, retUnlock);
         }
     }
 
     /**
-     * @return pthread_mutex_t& Reference of real mutex structrure.
+     * @return native_handle_type& Reference of real mutex structrure
+     * (pthread_mutex_t with pthread backends, futex word otherwise).
+     * BLET_MUTEX_NATIVE_HANDLE_PTHREAD is defined when it is pthread_mutex_t.
      */
-    pthread_mutex_t& native_handle() {
-        return mutex_;
+    native_handle_type& native_handle() {
+        return backend_.native_handle();
+    }
+
+    /**
+     * @return backend_type& Reference of backend selected at build time.
+     */
+    backend_type& backend() {
+        return backend_;
     }
 
   protected:
-    pthread_mutex_t mutex_;
+    backend_type backend_;
 
   private:
-    Mutex(const Mutex&) {}
+    Mutex(const Mutex&) :
+        backend_(NULL) {}
     Mutex& operator=(const Mutex&) {
         return *this;
     }
@@ -201,5 +496,6 @@ class LockGuard {
 #undef BLET_MUTEX_EXCEPTION_EAGAIN_
 #undef BLET_MUTEX_EXCEPTION_EDEADLK_
 #undef BLET_MUTEX_EXCEPTION_EPERM_
+#undef BLET_MUTEX_EXCEPTION_ENOTSUP_
 
 #endif // #ifndef BLET_MUTEX_H_
\ No newline at end of file
@@ -0,0 +1,361 @@
+/**
+ * rcu_cell.h
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * Copyright (c) 2024 BLET Mickaël.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BLET_RCU_CELL_H_
+#define BLET_RCU_CELL_H_
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "blet/detail/asymmetric_fence.h"
+#include "blet/mutex.h"
+
+#ifndef BLET_RCU_CACHELINE_SIZE
+#define BLET_RCU_CACHELINE_SIZE 64
+#endif
+
+#ifndef BLET_RCU_RETIRE_BATCH
+// number of retired callbacks which triggers a synchronize
+#define BLET_RCU_RETIRE_BATCH 128
+#endif
+
+namespace blet {
+
+namespace detail {
+
+/**
+ * @brief Process wide epoch domain shared by all RcuCell.
+ *
+ * Each reader thread owns a record where it publishes the global epoch when
+ * it enters its outermost read section and zero when it leaves it. A grace
+ * period increments the global epoch and waits the records which are in a
+ * read section started before the increment.
+ */
+class RcuDomain {
+  public:
+    typedef void (*Callback)(void* arg);
+
+    // one reader by cache line
+    struct __attribute__((aligned(BLET_RCU_CACHELINE_SIZE))) Reader {
+        unsigned long epoch;
+        unsigned int nesting;
+        Reader* pNext;
+    };
+
+    static RcuDomain& instance() {
+        // never destroyed: reader threads can outlive static destructors
+        static RcuDomain* pDomain = new RcuDomain();
+        return *pDomain;
+    }
+
+    void read_lock() {
+        Reader* pReader = tlsReader();
+        if (pReader == NULL) {
+            pReader = registerReader();
+        }
+        if (pReader->nesting++ == 0) {
+            // acquire: the loads of section can not pass the epoch load
+            __atomic_store_n(&pReader->epoch,
+                             __atomic_load_n(&epoch_, __ATOMIC_ACQUIRE),
+                             __ATOMIC_RELAXED);
+            AsymmetricFence::light();
+        }
+    }
+
+    void read_unlock() {
+        Reader* pReader = tlsReader();
+        if (--pReader->nesting == 0) {
+            __atomic_store_n(&pReader->epoch, 0, __ATOMIC_RELEASE);
+        }
+    }
+
+    void synchronize() {
+        std::vector<std::pair<Callback, void*> > callbacks;
+        {
+            LockGuard<Mutex> lockGuard(callbacksMutex_);
+            callbacks.swap(callbacks_);
+        }
+        {
+            LockGuard<Mutex> lockGuard(mutex_);
+            unsigned long epoch =
+                __atomic_add_fetch(&epoch_, 1, __ATOMIC_SEQ_CST);
+            AsymmetricFence::heavy();
+            for (Reader* pReader = pReaders_; pReader != NULL;
+                 pReader = pReader->pNext) {
+                for (;;) {
+                    unsigned long readerEpoch =
+                        __atomic_load_n(&pReader->epoch, __ATOMIC_ACQUIRE);
+                    if (readerEpoch == 0 || readerEpoch >= epoch) {
+                        break;
+                    }
+                    ::sched_yield();
+                }
+            }
+        }
+        for (std::size_t i = 0; i < callbacks.size(); ++i) {
+            callbacks[i].first(callbacks[i].second);
+        }
+    }
+
+    void retire(Callback callback, void* arg) {
+        bool isFull;
+        {
+            LockGuard<Mutex> lockGuard(callbacksMutex_);
+            callbacks_.push_back(std::pair<Callback, void*>(callback, arg));
+            isFull = callbacks_.size() >= BLET_RCU_RETIRE_BATCH;
+        }
+        if (isFull) {
+            synchronize();
+        }
+    }
+
+  protected:
+    RcuDomain() :
+        mutex_(),
+        epoch_(1),
+        pReaders_(NULL),
+        callbacksMutex_(),
+        callbacks_() {
+        ::pthread_key_create(&key_, &unregisterReader);
+    }
+    ~RcuDomain() {}
+
+    static Reader*& tlsReader() {
+        static __thread Reader* pReader = NULL;
+        return pReader;
+    }
+
+    Reader* registerReader() {
+        void* pMemory = NULL;
+        if (::posix_memalign(&pMemory, BLET_RCU_CACHELINE_SIZE,
+                             sizeof(Reader))) {
+            throw std::bad_alloc();
+        }
+        Reader* pReader = reinterpret_cast<Reader*>(pMemory);
+        pReader->epoch = 0;
+        pReader->nesting = 0;
+        {
+            LockGuard<Mutex> lockGuard(mutex_);
+            pReader->pNext = pReaders_;
+            pReaders_ = pReader;
+        }
+        ::pthread_setspecific(key_, pReader);
+        tlsReader() = pReader;
+        return pReader;
+    }
+
+    static void unregisterReader(void* arg) {
+        Reader* pReader = reinterpret_cast<Reader*>(arg);
+        RcuDomain& domain = instance();
+        {
+            LockGuard<Mutex> lockGuard(domain.mutex_);
+            Reader** ppReader = &domain.pReaders_;
+            while (*ppReader != pReader) {
+                ppReader = &(*ppReader)->pNext;
+            }
+            *ppReader = pReader->pNext;
+        }
+        tlsReader() = NULL;
+        ::free(pReader);
+    }
+
+    // serializes the grace periods and protects the readers
+    Mutex mutex_;
+    unsigned long epoch_;
+    Reader* pReaders_;
+    Mutex callbacksMutex_;
+    std::vector<std::pair<Callback, void*> > callbacks_;
+    pthread_key_t key_;
+
+  private:
+    RcuDomain(const RcuDomain&) {}
+    RcuDomain& operator=(const RcuDomain&) {
+        return *this;
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Read-copy-update cell for read mostly values.
+ *
+ * Readers enter a per-thread epoch section (ReadGuard or read_lock/
+ * read_unlock) and dereference the current value without any write on a
+ * shared cache line. Writers publish a new value with update, under a
+ * blet::Mutex, and the old value is deleted once every reader has left the
+ * sections started before the publication: by update which waits this grace
+ * period, or by a later synchronize with update_deferred.
+ *
+ * synchronize, update, update_deferred and retire (both can synchronize) must
+ * not be called inside a read section.
+ *
+ * @tparam T Type of value.
+ */
+template<typename T>
+class RcuCell {
+  public:
+    /**
+     * @brief Read section which holds the current value of cell.
+     */
+    class ReadGuard {
+      public:
+        ReadGuard(const RcuCell& cell) {
+            RcuCell::read_lock();
+            pValue_ = cell.read();
+        }
+        ~ReadGuard() {
+            RcuCell::read_unlock();
+        }
+        const T* get() const {
+            return pValue_;
+        }
+        const T& operator*() const {
+            return *pValue_;
+        }
+        const T* operator->() const {
+            return pValue_;
+        }
+
+      protected:
+        const T* pValue_;
+
+      private:
+        ReadGuard(const ReadGuard&) {}
+        ReadGuard& operator=(const ReadGuard&) {
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Construct a new RcuCell object.
+     *
+     * @param pValue Initial value allocated by new, owned by cell.
+     */
+    RcuCell(T* pValue = NULL) :
+        mutex_(),
+        pValue_(pValue) {}
+
+    /**
+     * @brief Destroy the RcuCell object after a grace period.
+     */
+    ~RcuCell() {
+        synchronize();
+        delete pValue_;
+    }
+
+    /**
+     * @brief Get the current value.
+     * Must be called inside a read section, the value is valid until the end
+     * of section.
+     */
+    const T* read() const {
+        return __atomic_load_n(&pValue_, __ATOMIC_CONSUME);
+    }
+
+    /**
+     * @brief Publish a new value, wait a grace period and delete the old.
+     *
+     * @param pValue New value allocated by new, owned by cell.
+     */
+    void update(T* pValue) {
+        T* pOld = exchange(pValue);
+        synchronize();
+        delete pOld;
+    }
+
+    /**
+     * @brief Publish a new value and retire the old, deleted by a later
+     * synchronize (at most BLET_RCU_RETIRE_BATCH retires later).
+     *
+     * @param pValue New value allocated by new, owned by cell.
+     */
+    void update_deferred(T* pValue) {
+        T* pOld = exchange(pValue);
+        if (pOld != NULL) {
+            retire(&deleteValue, pOld);
+        }
+    }
+
+    /**
+     * @brief Enter a read section, sections can be nested.
+     */
+    static void read_lock() {
+        detail::RcuDomain::instance().read_lock();
+    }
+
+    /**
+     * @brief Leave a read section.
+     */
+    static void read_unlock() {
+        detail::RcuDomain::instance().read_unlock();
+    }
+
+    /**
+     * @brief Wait a grace period: every read section started before the call
+     * is ended. The retired callbacks before the call are executed.
+     */
+    static void synchronize() {
+        detail::RcuDomain::instance().synchronize();
+    }
+
+    /**
+     * @brief Defer a callback after a grace period.
+     * A synchronize is done all BLET_RCU_RETIRE_BATCH retired callbacks.
+     *
+     * @param callback Function called with arg.
+     * @param arg Argument of callback.
+     */
+    static void retire(void (*callback)(void* arg), void* arg) {
+        detail::RcuDomain::instance().retire(callback, arg);
+    }
+
+  protected:
+    T* exchange(T* pValue) {
+        LockGuard<Mutex> lockGuard(mutex_);
+        return __atomic_exchange_n(&pValue_, pValue, __ATOMIC_RELEASE);
+    }
+
+    static void deleteValue(void* pValue) {
+        delete reinterpret_cast<T*>(pValue);
+    }
+
+    Mutex mutex_;
+    T* pValue_;
+
+  private:
+    RcuCell(const RcuCell&) {}
+    RcuCell& operator=(const RcuCell&) {
+        return *this;
+    }
+};
+
+} // namespace blet
+
+#endif // #ifndef BLET_RCU_CELL_H_
@@ -0,0 +1,211 @@
+/**
+ * spinlock.h
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * Copyright (c) 2024 BLET Mickaël.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BLET_SPINLOCK_H_
+#define BLET_SPINLOCK_H_
+
+#include <sched.h>
+#include <time.h>
+
+#include "blet/detail/cpu_relax.h"
+
+#ifndef BLET_SPINLOCK_CACHELINE_SIZE
+#define BLET_SPINLOCK_CACHELINE_SIZE 64
+#endif
+
+#ifndef BLET_SPINLOCK_YIELD_SPINS
+// default number of pause before yield the cpu
+#define BLET_SPINLOCK_YIELD_SPINS 1024
+#endif
+
+#ifndef BLET_SPINLOCK_MAX_BACKOFF
+// max number of pause between two tries
+#define BLET_SPINLOCK_MAX_BACKOFF 64
+#endif
+
+#ifndef BLET_SPINLOCK_DEBUG_HOLD_NS
+// hold duration flagged by debug mode
+#define BLET_SPINLOCK_DEBUG_HOLD_NS 10000
+#endif
+
+namespace blet {
+
+/**
+ * @brief Test and test-and-set spinlock for very short critical sections.
+ *
+ * A waiting thread spins on a relaxed load with an exponential backoff of
+ * pause instructions (up to BLET_SPINLOCK_MAX_BACKOFF) and yields the cpu
+ * once yieldSpins pauses have been spent.
+ *
+ * The object takes one cache line (BLET_SPINLOCK_CACHELINE_SIZE) when it is
+ * not allocated by new.
+ *
+ * If BLET_SPINLOCK_DEBUG is defined (in all translation units), the holds
+ * longer than BLET_SPINLOCK_DEBUG_HOLD_NS are counted by long_holds and
+ * reported to the long hold handler.
+ */
+class __attribute__((aligned(BLET_SPINLOCK_CACHELINE_SIZE))) SpinLock {
+  public:
+#if defined(BLET_SPINLOCK_DEBUG)
+    typedef void (*LongHoldHandler)(const SpinLock& spinlock,
+                                    unsigned long holdNs);
+#endif
+
+    /**
+     * @brief Construct a new unlocked SpinLock object.
+     *
+     * @param yieldSpins Number of pause before yield the cpu.
+     */
+    SpinLock(unsigned int yieldSpins = BLET_SPINLOCK_YIELD_SPINS) :
+        state_(0),
+        yieldSpins_(yieldSpins)
+#if defined(BLET_SPINLOCK_DEBUG)
+        ,
+        lockNs_(0),
+        longHolds_(0)
+#endif
+    {
+    }
+
+    /**
+     * @brief Destroy the SpinLock object.
+     */
+    ~SpinLock() {}
+
+    /**
+     * @brief Locks the spinlock, spins and yields until the lock is acquired.
+     *
+     * If lock is called by a thread that already owns the spinlock, the
+     * program deadlocks.
+     */
+    void lock() {
+        if (!try_lock()) {
+            lockSlow();
+#if defined(BLET_SPINLOCK_DEBUG)
+            lockNs_ = now();
+#endif
+        }
+    }
+
+    /**
+     * @brief Tries to lock the spinlock.
+     * Returns immediately. On successful lock acquisition returns true,
+     * otherwise returns false.
+     */
+    bool try_lock() {
+        if (__atomic_load_n(&state_, __ATOMIC_RELAXED) != 0 ||
+            __atomic_exchange_n(&state_, 1, __ATOMIC_ACQUIRE) != 0) {
+            return false;
+        }
+#if defined(BLET_SPINLOCK_DEBUG)
+        lockNs_ = now();
+#endif
+        return true;
+    }
+
+    /**
+     * @brief Unlocks the spinlock.
+     *
+     * The spinlock must be locked by the current thread of execution,
+     * otherwise, the behavior is undefined.
+     */
+    void unlock() {
+#if defined(BLET_SPINLOCK_DEBUG)
+        unsigned long holdNs = now() - lockNs_;
+        if (holdNs > BLET_SPINLOCK_DEBUG_HOLD_NS) {
+            __atomic_add_fetch(&longHolds_, 1, __ATOMIC_RELAXED);
+            if (longHoldHandler() != NULL) {
+                longHoldHandler()(*this, holdNs);
+            }
+        }
+#endif
+        __atomic_store_n(&state_, 0, __ATOMIC_RELEASE);
+    }
+
+#if defined(BLET_SPINLOCK_DEBUG)
+    /**
+     * @return unsigned long Number of holds longer than
+     * BLET_SPINLOCK_DEBUG_HOLD_NS.
+     */
+    unsigned long long_holds() const {
+        return __atomic_load_n(&longHolds_, __ATOMIC_RELAXED);
+    }
+
+    /**
+     * @return LongHoldHandler& Reference of handler called (under the lock)
+     * on each hold longer than BLET_SPINLOCK_DEBUG_HOLD_NS, NULL by default.
+     */
+    static LongHoldHandler& longHoldHandler() {
+        static LongHoldHandler handler = NULL;
+        return handler;
+    }
+#endif
+
+  protected:
+    void lockSlow() {
+        unsigned int spins = 0;
+        unsigned int backoff = 1;
+        while (__atomic_load_n(&state_, __ATOMIC_RELAXED) != 0 ||
+               __atomic_exchange_n(&state_, 1, __ATOMIC_ACQUIRE) != 0) {
+            if (spins < yieldSpins_) {
+                for (unsigned int i = 0; i < backoff; ++i) {
+                    detail::cpuRelax();
+                }
+                spins += backoff;
+                if (backoff < BLET_SPINLOCK_MAX_BACKOFF) {
+                    backoff <<= 1;
+                }
+            }
+            else {
+                ::sched_yield();
+            }
+        }
+    }
+
+#if defined(BLET_SPINLOCK_DEBUG)
+    static unsigned long now() {
+        struct timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+    }
+#endif
+
+    int state_;
+    unsigned int yieldSpins_;
+#if defined(BLET_SPINLOCK_DEBUG)
+    unsigned long lockNs_;
+    unsigned long longHolds_;
+#endif
+
+  private:
+    SpinLock(const SpinLock&) {}
+    SpinLock& operator=(const SpinLock&) {
+        return *this;
+    }
+};
+
+} // namespace blet
+
+#endif // #ifndef BLET_SPINLOCK_H_
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "blet/biased_mutex.h"
+#include "blet/lock_routines.h"
+
+namespace {
+
+struct TryLockArgs {
+    blet::BiasedMutex* pMutex;
+    int isDone;
+    int ret;
+};
+
+static void* tryLockOnceRoutine(void* arg) {
+    TryLockArgs* pArgs = reinterpret_cast<TryLockArgs*>(arg);
+    pArgs->ret = tryLockRoutine<blet::BiasedMutex>(pArgs->pMutex) != NULL;
+    __atomic_store_n(&pArgs->isDone, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// revocations which race with the owner
+struct RaceBiasedMutex : public blet::BiasedMutex {
+    bool lockBiasedRevokedAfterClaim() {
+        bool isClaimed = claimBias();
+        mutex_.lock();
+        revokeBias();
+        mutex_.unlock();
+        return isClaimed && lockBiased();
+    }
+    void revokeUnclaimed() {
+        mutex_.lock();
+        revokeBias();
+        mutex_.unlock();
+    }
+    bool isHolding() const {
+        return isOwnerHolding();
+    }
+};
+
+} // namespace
+
+GTEST_TEST(biased_mutex, owner) {
+    unsigned long revocations = blet::BiasedMutex::revocations();
+    blet::BiasedMutex mutex;
+    for (unsigned int i = 0; i < 1000; ++i) {
+        mutex.lock();
+        mutex.unlock();
+    }
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+    EXPECT_FALSE(mutex.is_revoked());
+    EXPECT_EQ(blet::BiasedMutex::revocations() - revocations, 0UL);
+}
+
+GTEST_TEST(biased_mutex, revocation) {
+    unsigned long revocations = blet::BiasedMutex::revocations();
+    blet::BiasedMutex mutex;
+    pthread_t tid;
+    void* pRet;
+
+    mutex.lock();
+    mutex.unlock();
+    pthread_create(&tid, NULL, &tryLockRoutine<blet::BiasedMutex>, &mutex);
+    pthread_join(tid, &pRet);
+    EXPECT_TRUE(pRet == &mutex);
+    EXPECT_TRUE(mutex.is_revoked());
+    EXPECT_EQ(blet::BiasedMutex::revocations() - revocations, 1UL);
+
+    // owner uses underlying mutex
+    mutex.lock();
+    pthread_create(&tid, NULL, &tryLockRoutine<blet::BiasedMutex>, &mutex);
+    pthread_join(tid, &pRet);
+    EXPECT_TRUE(pRet == NULL);
+    mutex.unlock();
+    EXPECT_EQ(blet::BiasedMutex::revocations() - revocations, 1UL);
+}
+
+GTEST_TEST(biased_mutex, try_lock_owner_holds) {
+    unsigned long revocations = blet::BiasedMutex::revocations();
+    blet::BiasedMutex mutex;
+    TryLockArgs args = {&mutex, 0, 1};
+    pthread_t tid;
+
+    mutex.lock();
+    pthread_create(&tid, NULL, &tryLockOnceRoutine, &args);
+    // try_lock must return while owner holds the bias
+    for (unsigned int i = 0; i < 1000; ++i) {
+        if (__atomic_load_n(&args.isDone, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        ::usleep(1000);
+    }
+    if (!__atomic_load_n(&args.isDone, __ATOMIC_ACQUIRE)) {
+        ADD_FAILURE() << "try_lock waits the owner";
+        mutex.unlock();
+        pthread_join(tid, NULL);
+        return;
+    }
+    pthread_join(tid, NULL);
+    EXPECT_EQ(args.ret, 0);
+    EXPECT_TRUE(mutex.is_revoked());
+    EXPECT_EQ(blet::BiasedMutex::revocations() - revocations, 1UL);
+
+    // lock of another thread waits the end of the biased hold of owner
+    LockCounter<blet::BiasedMutex> counter(mutex);
+    pthread_create(&tid, NULL, &incrementRoutine<blet::BiasedMutex>,
+                   &counter);
+    ::usleep(10000);
+    ++counter.value;
+    mutex.unlock();
+    pthread_join(tid, NULL);
+    EXPECT_EQ(counter.value, 1UL + BLET_LOCK_ROUTINES_INCREMENTS);
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+GTEST_TEST(biased_mutex, contention) {
+    unsigned long revocations = blet::BiasedMutex::revocations();
+    blet::BiasedMutex mutex;
+    LockCounter<blet::BiasedMutex> counter(mutex);
+    pthread_t tids[4];
+
+    // bias toward main thread, then interleave owner and other threads
+    incrementRoutine<blet::BiasedMutex>(&counter);
+    pthread_create(&tids[0], NULL, &incrementRoutine<blet::BiasedMutex>,
+                   &counter);
+    pthread_create(&tids[1], NULL, &tryIncrementRoutine<blet::BiasedMutex>,
+                   &counter);
+    pthread_create(&tids[2], NULL, &incrementRoutine<blet::BiasedMutex>,
+                   &counter);
+    pthread_create(&tids[3], NULL, &tryIncrementRoutine<blet::BiasedMutex>,
+                   &counter);
+    incrementRoutine<blet::BiasedMutex>(&counter);
+    for (unsigned int i = 0; i < 4; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+    EXPECT_EQ(counter.value, 6UL * BLET_LOCK_ROUTINES_INCREMENTS);
+    EXPECT_EQ(blet::BiasedMutex::revocations() - revocations, 1UL);
+}
+
+GTEST_TEST(biased_mutex, revocations) {
+    unsigned long revocations = blet::BiasedMutex::revocations();
+    blet::BiasedMutex mutexes[2];
+    pthread_t tid;
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        mutexes[i].lock();
+        mutexes[i].unlock();
+        pthread_create(&tid, NULL, &lockRoutine<blet::BiasedMutex>,
+                       &mutexes[i]);
+        pthread_join(tid, NULL);
+    }
+    // process wide counter
+    EXPECT_EQ(blet::BiasedMutex::revocations() - revocations, 2UL);
+}
+
+#if defined(BLET_MUTEX_NATIVE_HANDLE_PTHREAD)
+GTEST_TEST(biased_mutex, recursive_attribute) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    blet::BiasedMutex mutex(&attr);
+    pthread_mutexattr_destroy(&attr);
+    pthread_t tid;
+    void* pRet;
+
+    EXPECT_TRUE(mutex.is_revoked());
+    mutex.lock();
+    mutex.lock();
+    mutex.unlock();
+    // still held once
+    pthread_create(&tid, NULL, &tryLockRoutine<blet::BiasedMutex>, &mutex);
+    pthread_join(tid, &pRet);
+    EXPECT_TRUE(pRet == NULL);
+    EXPECT_NO_THROW(mutex.unlock());
+    pthread_create(&tid, NULL, &tryLockRoutine<blet::BiasedMutex>, &mutex);
+    pthread_join(tid, &pRet);
+    EXPECT_TRUE(pRet == &mutex);
+}
+
+GTEST_TEST(biased_mutex, errorcheck_attribute) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+    blet::BiasedMutex mutex(&attr);
+    pthread_mutexattr_destroy(&attr);
+
+    mutex.lock();
+    EXPECT_THROW(
+        {
+            try {
+                mutex.lock();
+            }
+            catch (const blet::Mutex::Exception& e) {
+                EXPECT_STREQ(e.what(),
+                             "the current thread already owns the mutex");
+                throw;
+            }
+        },
+        blet::Mutex::Exception);
+    mutex.unlock();
+}
+#endif
+
+GTEST_TEST(biased_mutex, revoked_after_claim) {
+    RaceBiasedMutex mutex;
+    EXPECT_FALSE(mutex.lockBiasedRevokedAfterClaim());
+    // owner backed out
+    EXPECT_FALSE(mutex.isHolding());
+    EXPECT_TRUE(mutex.is_revoked());
+    mutex.lock();
+    mutex.unlock();
+}
+
+GTEST_TEST(biased_mutex, revoked_unclaimed) {
+    unsigned long revocations = blet::BiasedMutex::revocations();
+    RaceBiasedMutex mutex;
+    mutex.revokeUnclaimed();
+    EXPECT_TRUE(mutex.is_revoked());
+    // no owner to revoke
+    EXPECT_EQ(blet::BiasedMutex::revocations() - revocations, 0UL);
+}
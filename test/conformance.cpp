@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "blet/lock_routines.h"
+#include "blet/mutex.h"
+
+namespace {
+
+template<typename T, typename U>
+struct IsSame {
+    enum {
+        value = false
+    };
+};
+
+template<typename T>
+struct IsSame<T, T> {
+    enum {
+        value = true
+    };
+};
+
+} // namespace
+
+GTEST_TEST(conformance, try_lock) {
+    blet::Mutex mutex;
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+GTEST_TEST(conformance, try_lock_locked_by_other_thread) {
+    blet::Mutex mutex;
+    pthread_t tid;
+    void* pRet;
+
+    mutex.lock();
+    pthread_create(&tid, NULL, &tryLockRoutine<blet::Mutex>, &mutex);
+    pthread_join(tid, &pRet);
+    EXPECT_TRUE(pRet == NULL);
+    mutex.unlock();
+
+    pthread_create(&tid, NULL, &tryLockRoutine<blet::Mutex>, &mutex);
+    pthread_join(tid, &pRet);
+    EXPECT_TRUE(pRet == &mutex);
+}
+
+GTEST_TEST(conformance, lock_locked_by_other_thread) {
+    blet::Mutex mutex;
+    pthread_t tid;
+
+    mutex.lock();
+    pthread_create(&tid, NULL, &lockRoutine<blet::Mutex>, &mutex);
+    // let the thread wait the mutex
+    ::usleep(10000);
+    mutex.unlock();
+    pthread_join(tid, NULL);
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+GTEST_TEST(conformance, mutual_exclusion) {
+    blet::Mutex mutex;
+    LockCounter<blet::Mutex> counter(mutex);
+    runIncrement(counter, 4);
+    EXPECT_EQ(counter.value, 4UL * BLET_LOCK_ROUTINES_INCREMENTS);
+}
+
+#if defined(BLET_MUTEX_NATIVE_HANDLE_PTHREAD)
+GTEST_TEST(conformance, native_handle_type) {
+    EXPECT_TRUE(
+        (IsSame<blet::Mutex::native_handle_type, pthread_mutex_t>::value));
+}
+
+GTEST_TEST(conformance, attributes) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+    blet::Mutex mutex(&attr);
+    pthread_mutexattr_destroy(&attr);
+    mutex.lock();
+    EXPECT_THROW(mutex.lock(), blet::Mutex::Exception);
+    mutex.unlock();
+}
+#else
+GTEST_TEST(conformance, native_handle_type) {
+    EXPECT_TRUE((IsSame<blet::Mutex::native_handle_type, int>::value));
+}
+
+GTEST_TEST(conformance, attributes) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    EXPECT_THROW(
+        {
+            try {
+                blet::Mutex mutex(&attr);
+            }
+            catch (const blet::Mutex::Exception& e) {
+                EXPECT_STREQ(
+                    e.what(),
+                    "the mutex attributes are not supported by the backend");
+                throw;
+            }
+        },
+        blet::Mutex::Exception);
+    pthread_mutexattr_destroy(&attr);
+}
+
+GTEST_TEST(conformance, unlock_unlocked) {
+    blet::Mutex mutex;
+    EXPECT_THROW(
+        {
+            try {
+                mutex.unlock();
+            }
+            catch (const blet::Mutex::Exception& e) {
+                EXPECT_STREQ(e.what(),
+                             "the current thread does not own the mutex");
+                throw;
+            }
+        },
+        blet::Mutex::Exception);
+}
+#endif
+
+#if defined(BLET_MUTEX_BACKEND_INSTRUMENTED)
+GTEST_TEST(conformance, instrumented_counters) {
+    blet::Mutex mutex;
+    mutex.lock();
+    mutex.unlock();
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+    EXPECT_EQ(mutex.backend().acquisitions(), 2UL);
+    EXPECT_EQ(mutex.backend().contentions(), 0UL);
+    EXPECT_EQ(mutex.backend().wait_ns(), 0UL);
+}
+
+GTEST_TEST(conformance, instrumented_contended_counters) {
+    blet::Mutex mutex;
+    pthread_t tid;
+
+    mutex.lock();
+    pthread_create(&tid, NULL, &lockRoutine<blet::Mutex>, &mutex);
+    // let the thread wait the mutex
+    ::usleep(10000);
+    mutex.unlock();
+    pthread_join(tid, NULL);
+    EXPECT_EQ(mutex.backend().acquisitions(), 2UL);
+    EXPECT_GE(mutex.backend().contentions(), 1UL);
+    EXPECT_GT(mutex.backend().wait_ns(), 0UL);
+}
+#endif
@@ -0,0 +1,92 @@
+#ifndef BLET_LOCK_ROUTINES_H_
+#define BLET_LOCK_ROUTINES_H_
+
+#include <pthread.h>
+
+#define BLET_LOCK_ROUTINES_INCREMENTS 100000
+
+/**
+ * @brief Counter protected by a lock, shared by the routines.
+ */
+template<typename Lock>
+struct LockCounter {
+    LockCounter(Lock& lock) :
+        lock(lock),
+        value(0) {}
+    Lock& lock;
+    unsigned long value;
+};
+
+/**
+ * @brief Increments BLET_LOCK_ROUTINES_INCREMENTS times the LockCounter arg
+ * with lock.
+ */
+template<typename Lock>
+void* incrementRoutine(void* arg) {
+    LockCounter<Lock>* pCounter = reinterpret_cast<LockCounter<Lock>*>(arg);
+    for (unsigned long i = 0; i < BLET_LOCK_ROUTINES_INCREMENTS; ++i) {
+        pCounter->lock.lock();
+        ++pCounter->value;
+        pCounter->lock.unlock();
+    }
+    return NULL;
+}
+
+/**
+ * @brief Increments BLET_LOCK_ROUTINES_INCREMENTS times the LockCounter arg
+ * with try_lock.
+ */
+template<typename Lock>
+void* tryIncrementRoutine(void* arg) {
+    LockCounter<Lock>* pCounter = reinterpret_cast<LockCounter<Lock>*>(arg);
+    for (unsigned long i = 0; i < BLET_LOCK_ROUTINES_INCREMENTS;) {
+        if (pCounter->lock.try_lock()) {
+            ++pCounter->value;
+            pCounter->lock.unlock();
+            ++i;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs incrementRoutine on nbThreads threads.
+ */
+template<typename Lock>
+void runIncrement(LockCounter<Lock>& counter, unsigned int nbThreads) {
+    pthread_t tids[16];
+    for (unsigned int i = 0; i < nbThreads; ++i) {
+        pthread_create(&tids[i], NULL, &incrementRoutine<Lock>, &counter);
+    }
+    for (unsigned int i = 0; i < nbThreads; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+}
+
+/**
+ * @brief Tries to lock the Lock arg and unlocks it on success.
+ *
+ * @return arg on success, NULL otherwise.
+ */
+template<typename Lock>
+void* tryLockRoutine(void* arg) {
+    Lock* pLock = reinterpret_cast<Lock*>(arg);
+    if (!pLock->try_lock()) {
+        return NULL;
+    }
+    pLock->unlock();
+    return arg;
+}
+
+/**
+ * @brief Locks and unlocks the Lock arg.
+ */
+template<typename Lock>
+void* lockRoutine(void* arg) {
+    Lock* pLock = reinterpret_cast<Lock*>(arg);
+    pLock->lock();
+    pLock->unlock();
+    return NULL;
+}
+
+#endif // #ifndef BLET_LOCK_ROUTINES_H_
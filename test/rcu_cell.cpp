@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "blet/rcu_cell.h"
+
+namespace {
+
+struct Value {
+    Value(int i) :
+        i(i) {
+        __atomic_add_fetch(&count, 1, __ATOMIC_RELAXED);
+    }
+    ~Value() {
+        i = -1;
+        __atomic_sub_fetch(&count, 1, __ATOMIC_RELAXED);
+    }
+    int i;
+    static int count;
+};
+
+int Value::count = 0;
+
+struct ReaderArgs {
+    blet::RcuCell<Value>* pCell;
+    int isStopped;
+    int isInSection;
+    int isReleased;
+    int errors;
+};
+
+static void* readerRoutine(void* arg) {
+    ReaderArgs* pArgs = reinterpret_cast<ReaderArgs*>(arg);
+    while (!__atomic_load_n(&pArgs->isStopped, __ATOMIC_ACQUIRE)) {
+        blet::RcuCell<Value>::ReadGuard readGuard(*pArgs->pCell);
+        if (readGuard->i < 0) {
+            ++pArgs->errors;
+        }
+    }
+    return NULL;
+}
+
+static void* holdRoutine(void* arg) {
+    ReaderArgs* pArgs = reinterpret_cast<ReaderArgs*>(arg);
+    blet::RcuCell<Value>::ReadGuard readGuard(*pArgs->pCell);
+    __atomic_store_n(&pArgs->isInSection, 1, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&pArgs->isReleased, __ATOMIC_ACQUIRE)) {
+        ::usleep(100);
+    }
+    if (readGuard->i != 0) {
+        ++pArgs->errors;
+    }
+    return NULL;
+}
+
+static void* synchronizeRoutine(void* /*arg*/) {
+    blet::RcuCell<Value>::synchronize();
+    return NULL;
+}
+
+static void retireCallback(void* arg) {
+    ++*reinterpret_cast<int*>(arg);
+}
+
+} // namespace
+
+GTEST_TEST(rcu_cell, read) {
+    blet::RcuCell<Value> cell(new Value(42));
+    {
+        blet::RcuCell<Value>::ReadGuard readGuard(cell);
+        EXPECT_EQ(readGuard->i, 42);
+        EXPECT_EQ((*readGuard).i, 42);
+        {
+            // nested section
+            blet::RcuCell<Value>::ReadGuard nestedGuard(cell);
+            EXPECT_EQ(nestedGuard.get(), readGuard.get());
+        }
+    }
+    cell.update(new Value(24));
+    {
+        blet::RcuCell<Value>::ReadGuard readGuard(cell);
+        EXPECT_EQ(readGuard->i, 24);
+    }
+}
+
+GTEST_TEST(rcu_cell, update) {
+    blet::RcuCell<Value> cell(new Value(0));
+    // old value deleted without explicit synchronize
+    cell.update(new Value(1));
+    EXPECT_EQ(Value::count, 1);
+}
+
+GTEST_TEST(rcu_cell, update_deferred) {
+    blet::RcuCell<Value> cell(new Value(0));
+    cell.update_deferred(new Value(1));
+    EXPECT_EQ(Value::count, 2);
+    blet::RcuCell<Value>::synchronize();
+    EXPECT_EQ(Value::count, 1);
+}
+
+GTEST_TEST(rcu_cell, reader_cacheline) {
+    EXPECT_EQ(sizeof(blet::detail::RcuDomain::Reader),
+              static_cast<size_t>(BLET_RCU_CACHELINE_SIZE));
+    EXPECT_EQ(__alignof__(blet::detail::RcuDomain::Reader),
+              static_cast<size_t>(BLET_RCU_CACHELINE_SIZE));
+}
+
+GTEST_TEST(rcu_cell, retire) {
+    int calls = 0;
+    blet::RcuCell<Value>::retire(&retireCallback, &calls);
+    EXPECT_EQ(calls, 0);
+    blet::RcuCell<Value>::synchronize();
+    EXPECT_EQ(calls, 1);
+
+    // batch
+    for (unsigned int i = 0; i < BLET_RCU_RETIRE_BATCH; ++i) {
+        blet::RcuCell<Value>::retire(&retireCallback, &calls);
+    }
+    EXPECT_EQ(calls, 1 + BLET_RCU_RETIRE_BATCH);
+}
+
+GTEST_TEST(rcu_cell, synchronize_waits_readers) {
+    blet::RcuCell<Value> cell(new Value(0));
+    ReaderArgs args = {&cell, 0, 0, 0, 0};
+    pthread_t holdTid;
+    pthread_t synchronizeTid;
+
+    pthread_create(&holdTid, NULL, &holdRoutine, &args);
+    while (!__atomic_load_n(&args.isInSection, __ATOMIC_ACQUIRE)) {
+        ::usleep(100);
+    }
+    cell.update_deferred(new Value(1));
+    pthread_create(&synchronizeTid, NULL, &synchronizeRoutine, NULL);
+    ::usleep(10000);
+    // old value is held by reader
+    EXPECT_EQ(Value::count, 2);
+    __atomic_store_n(&args.isReleased, 1, __ATOMIC_RELEASE);
+    pthread_join(synchronizeTid, NULL);
+    pthread_join(holdTid, NULL);
+    EXPECT_EQ(Value::count, 1);
+    EXPECT_EQ(args.errors, 0);
+}
+
+GTEST_TEST(rcu_cell, concurrent_updates) {
+    blet::RcuCell<Value>* pCell = new blet::RcuCell<Value>(new Value(0));
+    ReaderArgs args = {pCell, 0, 0, 0, 0};
+    pthread_t tids[4];
+
+    for (unsigned int i = 0; i < 4; ++i) {
+        pthread_create(&tids[i], NULL, &readerRoutine, &args);
+    }
+    for (int i = 1; i < 1000; ++i) {
+        if (i % 2) {
+            pCell->update(new Value(i));
+        }
+        else {
+            pCell->update_deferred(new Value(i));
+        }
+    }
+    __atomic_store_n(&args.isStopped, 1, __ATOMIC_RELEASE);
+    for (unsigned int i = 0; i < 4; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+    delete pCell;
+    blet::RcuCell<Value>::synchronize();
+    EXPECT_EQ(Value::count, 0);
+    EXPECT_EQ(args.errors, 0);
+}
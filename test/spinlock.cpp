@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include "blet/lock_routines.h"
+#include "blet/spinlock.h"
+
+GTEST_TEST(spinlock, cacheline) {
+    EXPECT_EQ(sizeof(blet::SpinLock),
+              static_cast<size_t>(BLET_SPINLOCK_CACHELINE_SIZE));
+}
+
+GTEST_TEST(spinlock, try_lock) {
+    blet::SpinLock spinlock;
+    EXPECT_TRUE(spinlock.try_lock());
+    EXPECT_FALSE(spinlock.try_lock());
+    spinlock.unlock();
+    EXPECT_TRUE(spinlock.try_lock());
+    spinlock.unlock();
+}
+
+GTEST_TEST(spinlock, mutual_exclusion) {
+    blet::SpinLock spinlock;
+    LockCounter<blet::SpinLock> counter(spinlock);
+    runIncrement(counter, 4);
+    EXPECT_EQ(counter.value, 4UL * BLET_LOCK_ROUTINES_INCREMENTS);
+}
+
+GTEST_TEST(spinlock, yield) {
+    // yield at first wait
+    blet::SpinLock spinlock(0);
+    LockCounter<blet::SpinLock> counter(spinlock);
+    runIncrement(counter, 4);
+    EXPECT_EQ(counter.value, 4UL * BLET_LOCK_ROUTINES_INCREMENTS);
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#define BLET_SPINLOCK_DEBUG
+#define BLET_SPINLOCK_DEBUG_HOLD_NS 1000000
+#include "blet/spinlock.h"
+
+namespace {
+
+static unsigned long handlerHoldNs = 0;
+
+static void longHoldHandler(const blet::SpinLock& /*spinlock*/,
+                            unsigned long holdNs) {
+    handlerHoldNs = holdNs;
+}
+
+} // namespace
+
+GTEST_TEST(spinlock_debug, long_holds) {
+    blet::SpinLock spinlock;
+    blet::SpinLock::longHoldHandler() = &longHoldHandler;
+
+    spinlock.lock();
+    spinlock.unlock();
+    EXPECT_EQ(spinlock.long_holds(), 0UL);
+    EXPECT_EQ(handlerHoldNs, 0UL);
+
+    spinlock.lock();
+    ::usleep(2000);
+    spinlock.unlock();
+    EXPECT_EQ(spinlock.long_holds(), 1UL);
+    EXPECT_GT(handlerHoldNs, 1000000UL);
+
+    EXPECT_TRUE(spinlock.try_lock());
+    ::usleep(2000);
+    spinlock.unlock();
+    EXPECT_EQ(spinlock.long_holds(), 2UL);
+
+    blet::SpinLock::longHoldHandler() = NULL;
+}